@@ -7,7 +7,8 @@ namespace eosio {
  * When a tx is received, the exchange will create an account or find an
  *existing one and add the amount to the account and to the liquid state
  **/
-void resource_exchange::deposit(currency::transfer tx) {
+template <typename market>
+void resource_exchange<market>::deposit(currency::transfer tx) {
   eosio_assert(tx.quantity.is_valid(), "invalid quantity");
   eosio_assert(tx.quantity.symbol == asset().symbol,
                "asset must be system token");
@@ -29,7 +30,8 @@ void resource_exchange::deposit(currency::transfer tx) {
  * the price will increase, reducing the resource consuption and the tokens will
  * be unstaked and accesible on 3 days
  **/
-void resource_exchange::withdraw(account_name to, asset quantity) {
+template <typename market>
+void resource_exchange<market>::withdraw(account_name to, asset quantity) {
   // TODO cancel buy tx if cant pay for it
   eosio_assert(quantity.is_valid(), "invalid quantity");
   eosio_assert(quantity.amount > 0, "must withdraw positive quantity");
@@ -6,9 +6,10 @@ namespace eosio {
 /**
  * Delegatebw is a shortcut for the delegatebw action
  **/
-void resource_exchange::delegatebw(account_name receiver,
-                                   asset stake_net_quantity,
-                                   asset stake_cpu_quantity) {
+template <typename market>
+void resource_exchange<market>::delegatebw(account_name receiver,
+                                           asset stake_net_quantity,
+                                           asset stake_cpu_quantity) {
   action(permission_level(_contract, N(active)), N(eosio), N(delegatebw),
          std::make_tuple(_contract, receiver, stake_net_quantity,
                          stake_cpu_quantity, false))
@@ -18,16 +19,18 @@ void resource_exchange::delegatebw(account_name receiver,
 /**
  * Unelegatebw is a shortcut for the unelegatebw action
  **/
-void resource_exchange::undelegatebw(account_name receiver,
-                                     asset stake_net_quantity,
-                                     asset stake_cpu_quantity) {
+template <typename market>
+void resource_exchange<market>::undelegatebw(account_name receiver,
+                                             asset stake_net_quantity,
+                                             asset stake_cpu_quantity) {
   action(permission_level(_contract, N(active)), N(eosio), N(undelegatebw),
          std::make_tuple(_contract, receiver, stake_net_quantity,
                          stake_cpu_quantity))
       .send();
 }
 
-void resource_exchange::unstakeunknown() {
+template <typename market>
+void resource_exchange<market>::unstakeunknown() {
   if (delegated_table.begin() == delegated_table.end()) {
     return;
   }
@@ -42,9 +45,16 @@ void resource_exchange::unstakeunknown() {
   }
 }
 
-void resource_exchange::matchbandwidth(account_name owner) {
-  auto user = accounts.find(owner);
-  auto delegated = delegated_table.find(user->owner);
+/**
+ * Computes the stake to delegate and undelegate so the delegated bandwidth
+ * matches the given resources, without sending any action
+ **/
+template <typename market>
+typename resource_exchange<market>::bandwidth_plan
+resource_exchange<market>::plan_bandwidth(account_name owner,
+                                          asset net_account,
+                                          asset cpu_account) {
+  auto delegated = delegated_table.find(owner);
 
   asset net_delegated = asset(0);
   asset cpu_delegated = asset(0);
@@ -53,28 +63,32 @@ void resource_exchange::matchbandwidth(account_name owner) {
     net_delegated = delegated->net_weight;
     cpu_delegated = delegated->cpu_weight;
   }
-  asset net_account = user->resource_net;
-  asset cpu_account = user->resource_cpu;
-  asset net_to_delegate = asset(0);
-  asset net_to_undelegate = asset(0);
-  asset cpu_to_delegate = asset(0);
-  asset cpu_to_undelegate = asset(0);
+  bandwidth_plan plan{asset(0), asset(0), asset(0), asset(0)};
   if (net_account > net_delegated) {
-    net_to_delegate += (net_account - net_delegated);
+    plan.net_to_delegate += (net_account - net_delegated);
   } else if (net_account < net_delegated) {
-    net_to_undelegate += (net_delegated - net_account);
+    plan.net_to_undelegate += (net_delegated - net_account);
   }
 
   if (cpu_account > cpu_delegated) {
-    cpu_to_delegate += (cpu_account - cpu_delegated);
+    plan.cpu_to_delegate += (cpu_account - cpu_delegated);
   } else if (cpu_account < cpu_delegated) {
-    cpu_to_undelegate += (cpu_delegated - cpu_account);
+    plan.cpu_to_undelegate += (cpu_delegated - cpu_account);
   }
-  if ((net_to_delegate + cpu_to_delegate) > asset(0)) {
-    delegatebw(user->owner, net_to_delegate, cpu_to_delegate);
+  return plan;
+}
+
+template <typename market>
+void resource_exchange<market>::matchbandwidth(account_name owner) {
+  auto user = accounts.find(owner);
+  bandwidth_plan plan =
+      plan_bandwidth(user->owner, user->resource_net, user->resource_cpu);
+
+  if (plan.delegates()) {
+    delegatebw(user->owner, plan.net_to_delegate, plan.cpu_to_delegate);
   }
-  if ((net_to_undelegate + cpu_to_undelegate) > asset(0)) {
-    undelegatebw(user->owner, net_to_undelegate, cpu_to_undelegate);
+  if (plan.undelegates()) {
+    undelegatebw(user->owner, plan.net_to_undelegate, plan.cpu_to_undelegate);
   }
 }
 
@@ -0,0 +1,2 @@
+#define RESOURCE_EXCHANGE_MARKET long_term_market
+#include "resource_exchange.cpp"
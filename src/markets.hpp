@@ -0,0 +1,37 @@
+#pragma once
+#include <eosiolib/types.hpp>
+
+namespace eosio {
+/**
+ * Market policies for resource_exchange, each one provides:
+ * cycle_time: seconds between billing cycles, longer than the unstake delay
+ * price_gap: fraction of the total funds that can be rented
+ * dev_fee: fraction of the collected fees kept for the developers
+ * cost_function: cost per Larimer given the total and liquid funds
+ **/
+struct standard_market {
+  static constexpr uint32_t cycle_time = 60 * 60 * 25 * 3;  // 3 days 3 hours
+  static constexpr double price_tune = 0.000001;
+  static constexpr double price_gap = 1.0;
+  static constexpr double dev_fee = 0.0;
+
+  static constexpr double cost_function(double total, double liquid) {
+    return 1.0 / (liquid - total + (total * price_gap)) / price_tune;
+  }
+};
+
+/**
+ * Long term pool, billed every week, the price scales with the total over the
+ * square of the liquid funds so it rises faster than the standard curve as the
+ * liquid funds run out
+ **/
+struct long_term_market : standard_market {
+  static constexpr uint32_t cycle_time = 60 * 60 * 24 * 7 + 60 * 60 * 3;
+
+  static constexpr double cost_function(double total, double liquid) {
+    return (total / (liquid - total + (total * price_gap))) /
+           (liquid - total + (total * price_gap)) / price_tune;
+  }
+};
+
+}  // namespace eosio
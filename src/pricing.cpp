@@ -6,7 +6,8 @@ namespace eosio {
  * Function to calculate aproximate cost of resources taking into account state
  * changes with purchase
  **/
-asset resource_exchange::calcost(asset resources) {
+template <typename market>
+asset resource_exchange<market>::calcost(asset resources) {
   if (resources <= asset(0)) {
     return asset(0);
   }
@@ -14,7 +15,7 @@ asset resource_exchange::calcost(asset resources) {
   auto state = contract_state.get();
   double_t liquid = state.liquid_funds.amount - resources.amount;
   double_t total = state.get_total().amount;
-  double_t cost_per_token = cost_function(total, liquid);
+  double_t cost_per_token = market::cost_function(total, liquid);
   asset price = asset(cost_per_token * resources.amount);
   print("price: ", price);
   return price;
@@ -23,24 +24,21 @@ asset resource_exchange::calcost(asset resources) {
 /**
  * Returns cost per Larimer
  **/
-double resource_exchange::calcosttoken() {
+template <typename market>
+double resource_exchange<market>::calcosttoken() {
   eosio_assert(contract_state.exists(), "No contract state available");
   auto state = contract_state.get();
   double liquid = state.liquid_funds.amount;
   double total = state.get_total().amount;
   eosio_assert(liquid > 0 && total > 0, "No funds to price");
-  double cost_per_token = cost_function(total, liquid);
+  double cost_per_token = market::cost_function(total, liquid);
   print(cost_per_token);
   return cost_per_token;
 }
 
-double resource_exchange::cost_function(double total, double liquid) {
-  double used = total - liquid;
-  double price = 1.0 / (-used + (total * PRICE_GAP));
-  return price / PRICE_TUNE;
-}
-
-void resource_exchange::payreward(account_name user, asset fee_collected) {
+template <typename market>
+void resource_exchange<market>::payreward(account_name user,
+                                          asset fee_collected) {
   auto state = contract_state.get();
   double reward_per_token = fee_collected.amount / state.get_total().amount;
   auto acnt = accounts.find(user);
@@ -49,53 +47,69 @@ void resource_exchange::payreward(account_name user, asset fee_collected) {
                   [&](auto& account) { account.balance += asset(reward); });
 }
 
-asset resource_exchange::billaccount(account_name owner,
+/**
+ * Computes the outcome of billing an account for the next cycle without
+ * modifying any table
+ **/
+template <typename market>
+typename resource_exchange<market>::bill_plan
+resource_exchange<market>::plan_bill(const account_t& acnt,
                                      double cost_per_token) {
-  auto acnt = accounts.find(owner);
-  auto pending_itr = pendingtxs.find(acnt->owner);
+  auto pending_itr = pendingtxs.find(acnt.owner);
+  bool has_pending = pending_itr != pendingtxs.end();
 
-  auto cost_all = asset(cost_per_token * acnt->get_all().amount);
-  asset extra_net = asset(0);
-  asset extra_cpu = asset(0);
-  asset fee_collected = asset(0);
+  bill_plan plan{asset(0), acnt.resource_net, acnt.resource_cpu, false, false};
+  auto cost_account = asset(cost_per_token * acnt.get_all().amount);
+  auto cost_all = cost_account;
 
-  if (pending_itr != pendingtxs.end()) {
+  if (has_pending) {
     cost_all += asset(cost_per_token * pending_itr->get_all().amount);
-    extra_net += pending_itr->net;
-    extra_cpu += pending_itr->cpu;
   }
 
   eosio_assert(cost_all.amount >= 0, "cost negative");
-  if (acnt->balance >= cost_all) {
-    accounts.modify(acnt, 0, [&](auto& account) {
-      account.balance -= cost_all;
-      account.resource_net += extra_net;
-      account.resource_cpu += extra_cpu;
-    });
-    fee_collected += cost_all;
+  if (acnt.balance >= cost_all) {
+    plan.fee = cost_all;
+    if (has_pending) {
+      plan.resource_net += pending_itr->net;
+      plan.resource_cpu += pending_itr->cpu;
+    }
   } else {
     // Cancel purchase stake tx, pay just account
-    if (pending_itr != pendingtxs.end()) {
-      reset_delayed_tx(*pending_itr);
-    }
-    asset cost_account = asset(cost_per_token * acnt->get_all().amount);
-    if (acnt->balance >= cost_account) {
-      accounts.modify(acnt, 0,
-                      [&](auto& account) { account.balance -= cost_account; });
-      fee_collected += cost_account;
+    plan.cancel_pending = has_pending;
+    if (acnt.balance >= cost_account) {
+      plan.fee = cost_account;
     } else {
       // can't pay for account, reset account
-      state_on_reset_account(acnt->resource_net + acnt->resource_cpu);
-      accounts.modify(acnt, 0, [&](auto& account) {
-        account.resource_net = asset(0);
-        account.resource_cpu = asset(0);
-      });
+      plan.reset = true;
+      plan.resource_net = asset(0);
+      plan.resource_cpu = asset(0);
     }
   }
+  return plan;
+}
+
+template <typename market>
+asset resource_exchange<market>::billaccount(account_name owner,
+                                             double cost_per_token) {
+  auto acnt = accounts.find(owner);
+  auto pending_itr = pendingtxs.find(acnt->owner);
+  bill_plan plan = plan_bill(*acnt, cost_per_token);
+
+  if (plan.cancel_pending) {
+    reset_delayed_tx(*pending_itr);
+  }
+  if (plan.reset) {
+    state_on_reset_account(acnt->resource_net + acnt->resource_cpu);
+  }
+  accounts.modify(acnt, 0, [&](auto& account) {
+    account.balance -= plan.fee;
+    account.resource_net = plan.resource_net;
+    account.resource_cpu = plan.resource_cpu;
+  });
   if (pending_itr != pendingtxs.end()) {
     pendingtxs.erase(pending_itr);
   }
-  return fee_collected;
+  return plan.fee;
 }
 
 }  // namespace eosio
\ No newline at end of file
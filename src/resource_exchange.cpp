@@ -1,12 +1,15 @@
 #include "resource_exchange.hpp"
+#include "markets.hpp"
 #include "accounts.cpp"
 #include "bandwidth.cpp"
 #include "pricing.cpp"
 #include "stake.cpp"
 #include "state_manager.cpp"
+#include "twap.cpp"
 
 namespace eosio {
-void resource_exchange::apply(account_name contract, account_name act) {
+template <typename market>
+void resource_exchange<market>::apply(account_name contract, account_name act) {
   state_init();
 
   switch (act) {
@@ -43,14 +46,25 @@ void resource_exchange::apply(account_name contract, account_name act) {
       cycle();
       break;
     }
+    case N(previewcycle): {
+      auto query = unpack_action_data<preview_query>();
+      previewcycle(query.cursor, query.limit);
+      break;
+    }
     case N(calcosttoken): {
       calcosttoken();
       break;
     }
+    case N(calctwap): {
+      auto query = unpack_action_data<twap_query>();
+      calctwap(query.window);
+      break;
+    }
   }
 }
 
-void resource_exchange::cycle() {
+template <typename market>
+void resource_exchange<market>::cycle() {
   print("Run cycle\n");
   auto secs_to_next = time_point_sec(CYCLE_TIME);
   auto secs_flexibility = time_point_sec(5);
@@ -68,14 +82,15 @@ void resource_exchange::cycle() {
   state_set_timestamp(this_time);
 }
 
-void resource_exchange::docycle() {
+template <typename market>
+void resource_exchange<market>::docycle() {
   double cost_per_token = calcosttoken();
   asset fees_collected = asset(0);
   for (auto acnt = accounts.begin(); acnt != accounts.end(); ++acnt) {
     fees_collected += billaccount(acnt->owner, cost_per_token);
     matchbandwidth(acnt->owner);
   }
-  asset fees_devs = asset(fees_collected.amount * 0.0);
+  asset fees_devs = asset(fees_collected.amount * DEV_FEE);
   for (auto acnt = accounts.begin(); acnt != accounts.end(); ++acnt) {
     payreward(acnt->owner, fees_collected - fees_devs);
   }
@@ -87,11 +102,70 @@ void resource_exchange::docycle() {
   print("Total fees: ", fees_collected, " ");
 }
 
+/**
+ * Projects what the next cycle would do for up to limit accounts starting at
+ * cursor, without modifying any table. Prints the aggregates and the cursor
+ * of the next page, 0 once every account has been covered
+ **/
+template <typename market>
+void resource_exchange<market>::previewcycle(account_name cursor,
+                                             uint32_t limit) {
+  eosio_assert(limit > 0, "limit must be positive");
+  eosio_assert(contract_state.exists(), "No contract state available");
+  auto state = contract_state.get();
+  double liquid = state.liquid_funds.amount;
+  double total = state.get_total().amount;
+  eosio_assert(liquid > 0 && total > 0, "No funds to price");
+  double cost_per_token = market::cost_function(total, liquid);
+
+  uint32_t billed = 0;
+  uint32_t resets = 0;
+  uint32_t cancelled = 0;
+  uint32_t delegates = 0;
+  uint32_t undelegates = 0;
+  asset fees_collected = asset(0);
+
+  auto acnt = accounts.lower_bound(cursor);
+  for (; acnt != accounts.end() && billed < limit; ++acnt, ++billed) {
+    bill_plan bill = plan_bill(*acnt, cost_per_token);
+    fees_collected += bill.fee;
+    resets += bill.reset;
+    cancelled += bill.cancel_pending;
+
+    bandwidth_plan bandwidth =
+        plan_bandwidth(acnt->owner, bill.resource_net, bill.resource_cpu);
+    delegates += bandwidth.delegates();
+    undelegates += bandwidth.undelegates();
+  }
+  account_name next = acnt == accounts.end() ? 0 : acnt->owner;
+
+  // unknown delegations share the key range of the accounts page
+  uint32_t unknown = 0;
+  for (auto delegated = delegated_table.lower_bound(cursor);
+       delegated != delegated_table.end() &&
+       (next == 0 || delegated->to < next);
+       ++delegated) {
+    if (accounts.find(delegated->to) == accounts.end() &&
+        delegated->to != _contract) {
+      ++unknown;
+    }
+  }
+
+  print("accounts: ", billed, " resets: ", resets, " cancelled: ", cancelled,
+        " fees: ", fees_collected, " delegatebw: ", delegates,
+        " undelegatebw: ", undelegates + unknown, " next: ", name{next},
+        "\n");
+}
+
 }  // namespace eosio
 
+#ifndef RESOURCE_EXCHANGE_MARKET
+#define RESOURCE_EXCHANGE_MARKET standard_market
+#endif
+
 extern "C" {
 [[noreturn]] void apply(uint64_t receiver, uint64_t code, uint64_t action) {
-  eosio::resource_exchange ex(receiver);
+  eosio::resource_exchange<eosio::RESOURCE_EXCHANGE_MARKET> ex(receiver);
   ex.apply(code, action);
   eosio_exit(0);
 }
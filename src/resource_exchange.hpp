@@ -7,12 +7,26 @@
 #include <eosiolib/transaction.hpp>
 #include <eosiolib/types.hpp>
 namespace eosio {
+/**
+ * The market policy provides the pricing curve and parameters of a market as
+ * constexpr members, see markets.hpp
+ **/
+template <typename market>
 class resource_exchange : public eosio::contract {
  private:
   account_name _contract;
-  const uint32_t CYCLE_TIME = 60 * 60 * 25 * 3;  // 3 days and three hours
-  const double PRICE_TUNE = 0.000001;
-  const double PRICE_GAP = 1.0;
+  static constexpr uint32_t CYCLE_TIME = market::cycle_time;
+  static constexpr double PRICE_GAP = market::price_gap;
+  static constexpr double DEV_FEE = market::dev_fee;
+  static constexpr uint32_t UNSTAKE_DELAY = 60 * 60 * 24 * 3;
+  static constexpr uint32_t TWAP_PERIOD = 60 * 60 * 3;  // history granularity
+  static constexpr uint32_t TWAP_SLOTS = 48;  // 6 days of price history
+
+  // refunding stake is counted as liquid one cycle after undelegating it
+  static_assert(CYCLE_TIME > UNSTAKE_DELAY,
+                "market cycle must be longer than the unstake delay");
+  // fees kept for the developers are not paid out yet
+  static_assert(DEV_FEE == 0, "market dev fee requires developer payout");
 
   struct stake_trade {
     account_name user;
@@ -25,6 +39,36 @@ class resource_exchange : public eosio::contract {
     asset quantity;
   };
 
+  struct twap_query {
+    uint32_t window;
+  };
+
+  struct preview_query {
+    account_name cursor;
+    uint32_t limit;
+  };
+
+  struct bill_plan {
+    asset fee;
+    asset resource_net;
+    asset resource_cpu;
+    bool cancel_pending;
+    bool reset;
+  };
+
+  struct bandwidth_plan {
+    asset net_to_delegate;
+    asset net_to_undelegate;
+    asset cpu_to_delegate;
+    asset cpu_to_undelegate;
+    bool delegates() const {
+      return (net_to_delegate + cpu_to_delegate) > asset(0);
+    }
+    bool undelegates() const {
+      return (net_to_undelegate + cpu_to_undelegate) > asset(0);
+    }
+  };
+
   //@abi table pendingtx i64
   struct pendingtx {
     pendingtx(account_name o = account_name()) : user(o) {}
@@ -56,6 +100,25 @@ class resource_exchange : public eosio::contract {
                                   to_be_refunding)(refunding))
   };
 
+  //@abi table twapstate i64
+  struct twap_state_t {
+    time_point_sec timestamp;
+    double price;
+    double price_cumulative;
+
+    EOSLIB_SERIALIZE(twap_state_t, (timestamp)(price)(price_cumulative))
+  };
+
+  //@abi table pricehist i64
+  struct price_obs {
+    uint64_t slot;
+    uint32_t period;
+    double price_cumulative;
+
+    uint64_t primary_key() const { return slot; }
+    EOSLIB_SERIALIZE(price_obs, (slot)(period)(price_cumulative))
+  };
+
   //@abi table account i64
   struct account_t {
     account_t(account_name o = account_name()) : owner(o) {}
@@ -95,6 +158,12 @@ class resource_exchange : public eosio::contract {
   typedef singleton<N(state), state_t> state_index;
   state_index contract_state;
 
+  typedef singleton<N(twapstate), twap_state_t> twap_state_index;
+  twap_state_index twap_state;
+
+  typedef eosio::multi_index<N(pricehist), price_obs> price_history_index;
+  price_history_index price_history;
+
   typedef eosio::multi_index<N(account), account_t> account_index;
   account_index accounts;
 
@@ -109,10 +178,11 @@ class resource_exchange : public eosio::contract {
   void dobuystake(account_name user, asset net, asset cpu);
 
   void reset_delayed_tx(pendingtx tx);
+  bill_plan plan_bill(const account_t& acnt, double cost_per_token);
   asset billaccount(account_name account, double cost_per_token);
+  bandwidth_plan plan_bandwidth(account_name user, asset net, asset cpu);
   void matchbandwidth(account_name user);
   void payreward(account_name user, asset fee_collected);
-  double cost_function(double total, double liquid);
   void unstakeunknown();
 
   void state_on_deposit(asset quantity);
@@ -127,6 +197,9 @@ class resource_exchange : public eosio::contract {
   void state_cycle();
   void state_init();
 
+  void twap_observe(const state_t& state);
+  double twap_cumulative_at(uint32_t time);
+
   void docycle();
 
  public:
@@ -137,7 +210,9 @@ class resource_exchange : public eosio::contract {
         pendingtxs(_self, _self),
         delegated_table(N(eosio), _self),
         contract_balance(N(eosio.token), _self),
-        contract_state(_self, _self) {}
+        contract_state(_self, _self),
+        twap_state(_self, _self),
+        price_history(_self, _self) {}
 
   del_bandwidth_table delegated_table;
   account_balances contract_balance;
@@ -159,7 +234,13 @@ class resource_exchange : public eosio::contract {
   /// @abi action
   double calcosttoken();
 
+  /// @abi action
+  double calctwap(uint32_t window);
+
   /// @abi action
   void cycle();
+
+  /// @abi action
+  void previewcycle(account_name cursor, uint32_t limit);
 };
 }  // namespace eosio
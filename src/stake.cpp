@@ -8,7 +8,9 @@ namespace eosio {
  * it will update an existing scheduled purchase or create a new one
  * and will set the funds as staked
  **/
-void resource_exchange::buystake(account_name from, asset net, asset cpu) {
+template <typename market>
+void resource_exchange<market>::buystake(account_name from, asset net,
+                                         asset cpu) {
   eosio_assert(net.is_valid() && cpu.is_valid(), "invalid quantity");
   eosio_assert(net.symbol == asset().symbol && cpu.symbol == asset().symbol,
                "asset must be system token");
@@ -52,7 +54,9 @@ void resource_exchange::buystake(account_name from, asset net, asset cpu) {
  * Sellstake will remove resources used from a delayed tx if any
  * or sell the remove resources used from the account
  **/
-void resource_exchange::sellstake(account_name user, asset net, asset cpu) {
+template <typename market>
+void resource_exchange<market>::sellstake(account_name user, asset net,
+                                          asset cpu) {
   // to sell reduce account resources, in next cycle he will pay the new usage
   eosio_assert(net.is_valid() && cpu.is_valid(), "invalid quantity");
   eosio_assert(net >= asset(0) && cpu >= asset(0) && (net + cpu) > asset(0),
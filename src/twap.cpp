@@ -0,0 +1,102 @@
+#pragma once
+#include "resource_exchange.hpp"
+
+namespace eosio {
+/**
+ * Records the price implied by a new state. The running accumulator holds
+ * the integral of the price over time, and the first observation of every
+ * TWAP_PERIOD stores the accumulator value at the start of that period in a
+ * ring buffer of TWAP_SLOTS entries
+ **/
+template <typename market>
+void resource_exchange<market>::twap_observe(const state_t& state) {
+  double liquid = state.liquid_funds.amount;
+  double total = state.get_total().amount;
+  uint32_t time = now();
+
+  if (!twap_state.exists()) {
+    if (liquid <= 0 || total <= 0) {
+      return;
+    }
+    twap_state.set(twap_state_t{time_point_sec(time),
+                                market::cost_function(total, liquid), 0.0},
+                   _self);
+    return;
+  }
+
+  auto last = twap_state.get();
+  uint32_t last_time = last.timestamp.utc_seconds;
+  uint32_t period = time / TWAP_PERIOD;
+  uint32_t first = last_time / TWAP_PERIOD + 1;
+  if (period >= TWAP_SLOTS && first + TWAP_SLOTS <= period) {
+    // older periods would be overwritten in this same loop
+    first = period - TWAP_SLOTS + 1;
+  }
+
+  // price was constant since the last observation, fill crossed periods
+  for (uint32_t p = first; p <= period; ++p) {
+    double cumulative =
+        last.price_cumulative + last.price * (p * TWAP_PERIOD - last_time);
+    auto itr = price_history.find(p % TWAP_SLOTS);
+    if (itr == price_history.end()) {
+      price_history.emplace(_self, [&](auto& obs) {
+        obs.slot = p % TWAP_SLOTS;
+        obs.period = p;
+        obs.price_cumulative = cumulative;
+      });
+    } else {
+      price_history.modify(itr, 0, [&](auto& obs) {
+        obs.period = p;
+        obs.price_cumulative = cumulative;
+      });
+    }
+  }
+
+  // without liquid funds there is no quote, carry the last price forward
+  double price = last.price;
+  if (liquid > 0 && total > 0) {
+    price = market::cost_function(total, liquid);
+  }
+  twap_state.set(
+      twap_state_t{time_point_sec(time), price,
+                   last.price_cumulative + last.price * (time - last_time)},
+      _self);
+}
+
+/**
+ * Returns the price accumulator at the given time, which must be either
+ * after the last observation or the start of a period kept in the history
+ **/
+template <typename market>
+double resource_exchange<market>::twap_cumulative_at(uint32_t time) {
+  auto last = twap_state.get();
+  uint32_t last_time = last.timestamp.utc_seconds;
+  if (time >= last_time) {
+    return last.price_cumulative + last.price * (time - last_time);
+  }
+  auto obs = price_history.find((time / TWAP_PERIOD) % TWAP_SLOTS);
+  eosio_assert(obs != price_history.end() && obs->period == time / TWAP_PERIOD,
+               "window exceeds price history");
+  return obs->price_cumulative;
+}
+
+/**
+ * Returns the time weighted average cost per Larimer over the last window
+ * seconds, the start of the window is rounded down to a TWAP_PERIOD boundary
+ **/
+template <typename market>
+double resource_exchange<market>::calctwap(uint32_t window) {
+  eosio_assert(twap_state.exists(), "No price history available");
+  uint32_t time = now();
+  eosio_assert(window > 0 && window <= time, "invalid window");
+  uint32_t start = (time - window) / TWAP_PERIOD * TWAP_PERIOD;
+  eosio_assert(time / TWAP_PERIOD - start / TWAP_PERIOD < TWAP_SLOTS,
+               "window exceeds price history");
+
+  double twap = (twap_cumulative_at(time) - twap_cumulative_at(start)) /
+                (time - start);
+  print(twap);
+  return twap;
+}
+
+}  // namespace eosio